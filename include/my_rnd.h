@@ -25,6 +25,7 @@ struct my_rnd_struct {
 
 void my_rnd_init(struct my_rnd_struct *rand_st, ulong seed1, ulong seed2);
 double my_rnd(struct my_rnd_struct *rand_st);
+void my_rnd_batch(struct my_rnd_struct *rand_st, double *out, size_t n);
 double my_rnd_ssl(struct my_rnd_struct *rand_st);
 
 C_MODE_END
@@ -29,6 +29,319 @@
 #include <openssl/rand.h>
 #endif /* HAVE_YASSL */
 
+/** The modulus that my_rnd_init() always installs */
+#define MY_RND_MAX_VALUE 0x3FFFFFFFUL
+
+/**
+  Compute x % MY_RND_MAX_VALUE without a division instruction.
+
+  The modulus is the Mersenne-shaped 2^30 - 1, so the classic folding
+  identity applies: (x & M) + (x >> 30) is congruent to x mod M. With
+  seeds below M the recurrence never exceeds 4*M, but the seeds are
+  not guaranteed to be below M: SET SESSION rand_seed1/rand_seed2 and
+  a replicated RAND_EVENT store raw values straight into
+  thd->rand.seed1/seed2 with no reduction. Fold twice, which brings
+  any value of the full ulong range below 2*M, and finish with one
+  branchless masked subtract. The result equals x % M exactly for
+  every operand, so the generated sequence - which the password
+  scramble and replication of RAND() depend on - is unchanged; the
+  ~20-cycle division becomes four adds, two shifts and two masks.
+
+  @param x	value to reduce
+
+  @retval	x % MY_RND_MAX_VALUE
+*/
+
+static inline unsigned long my_mod_max_value(unsigned long x)
+{
+  unsigned long r= (x & MY_RND_MAX_VALUE) + (x >> 30);
+
+  r= (r & MY_RND_MAX_VALUE) + (r >> 30);
+  r-= (-(unsigned long)(r >= MY_RND_MAX_VALUE)) & MY_RND_MAX_VALUE;
+  return r;
+}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define HAVE_my_rdrand
+
+/** Number of times an RDRAND execution is retried before giving up.
+Intel recommends a bounded retry loop of 10; a correctly working CPU
+practically never needs more than one retry. */
+#define MY_RDRAND_RETRIES 10
+
+/** 1 if the CPU supports the RDRAND instruction, 0 if not,
+-1 if not yet detected. Lazily initialized from my_rdrand_detect();
+the racy initialization is harmless as all threads compute the
+same value. */
+static int my_rdrand_usable= -1;
+
+/**
+  Check through CPUID whether the CPU supports RDRAND
+  (Intel Secure Key, CPUID.01H:ECX.RDRAND[bit 30]).
+
+  We use inline assembly instead of the _rdrand32_step() intrinsic:
+  it does not require building this file with -mrdrnd, and it reads
+  the carry flag directly, which avoids miscompilation of the
+  intrinsic by some GCC versions (GCC bug 81300, CVE-2017-11671).
+
+  @retval 1	RDRAND is available
+  @retval 0	RDRAND is not available
+*/
+
+static int my_rdrand_detect(void)
+{
+  unsigned int eax, ebx, ecx, edx;
+
+  asm("cpuid" : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+      : "a" (1), "c" (0));
+  return (ecx >> 30) & 1;
+}
+
+/**
+  Read one 64-bit hardware random number.
+
+  @param res [OUT]	the random number, undefined on failure
+
+  @retval 1	success
+  @retval 0	the hardware entropy source was exhausted even
+                after MY_RDRAND_RETRIES retries
+*/
+
+static int my_rdrand64(unsigned long long *res)
+{
+  unsigned char ok;
+  unsigned int i;
+
+  for (i= 0; i < MY_RDRAND_RETRIES; i++)
+  {
+    asm volatile("rdrand %0; setc %1" : "=r" (*res), "=qm" (ok));
+    if (ok)
+      return 1;
+  }
+  return 0;
+}
+
+/** Number of 64-bit words drawn from the hardware in one refill burst */
+#define MY_RDRAND_CACHE_WORDS 64
+
+/**
+  Per-thread cache of hardware random numbers.
+
+  A single RDRAND execution is expensive (and serialized across cores
+  on SRBDS-mitigated microcode), so we draw MY_RDRAND_CACHE_WORDS
+  64-bit words in one burst and hand them out 32 bits at a time;
+  the common case is then just a load and an index decrement.
+*/
+struct my_rdrand_cache
+{
+  unsigned long long buf[MY_RDRAND_CACHE_WORDS];
+  unsigned int words_left;              /* 32-bit words still unread */
+};
+
+static __thread struct my_rdrand_cache rdrand_cache;
+
+/**
+  Read one 32-bit hardware random number through the per-thread cache,
+  refilling the cache from RDRAND when it is empty.
+
+  @param res [OUT]	the random number, undefined on failure
+
+  @retval 1	success
+  @retval 0	the hardware entropy source was exhausted even
+                after MY_RDRAND_RETRIES retries per word
+*/
+
+static int my_rdrand32(unsigned int *res)
+{
+  struct my_rdrand_cache *cache= &rdrand_cache;
+
+  if (cache->words_left == 0)
+  {
+    unsigned int i;
+
+    for (i= 0; i < MY_RDRAND_CACHE_WORDS; i++)
+    {
+      if (!my_rdrand64(&cache->buf[i]))
+        return 0;                       /* Leave the cache empty */
+    }
+    cache->words_left= 2 * MY_RDRAND_CACHE_WORDS;
+  }
+  cache->words_left--;
+  *res= ((unsigned int*) cache->buf)[cache->words_left];
+  return 1;
+}
+#if __GNUC__ >= 5
+#define HAVE_my_rnd_avx2
+#include <immintrin.h>
+
+/** 1 if the CPU supports AVX2, 0 if not, -1 if not yet detected */
+static int my_avx2_usable= -1;
+
+/**
+  Check whether AVX2 can be used.
+
+  __builtin_cpu_supports() performs the complete sequence: maximum
+  basic CPUID leaf >= 7 (on older CPUs an EAX=7 query would return
+  data of some other leaf), the AVX2 bit itself, and OSXSAVE plus
+  XGETBV to verify that the OS actually saves and restores the YMM
+  registers - without that last check the first AVX2 instruction
+  would raise SIGILL even though the hardware bit is set.
+
+  @retval 1	AVX2 is available
+  @retval 0	AVX2 is not available
+*/
+
+static int my_avx2_detect(void)
+{
+  return __builtin_cpu_supports("avx2") != 0;
+}
+
+/**
+  One my_rnd step is the affine map mod M = MY_RND_MAX_VALUE
+
+    seed1' = 3*seed1 +   seed2
+    seed2' = 3*seed1 + 2*seed2 + 33
+
+  my_rnd_batch_avx2() keeps four consecutive states of the sequence in
+  the 64-bit lanes of a ymm register and advances all of them by four
+  steps at a time with the composed map T^4. An affine map composed
+  with itself stays affine, so T^4 is again five constants mod M,
+  computed once per call by my_rnd_compose(). Every operation is exact
+  mod M, which keeps the output bit-identical to n scalar my_rnd()
+  calls.
+*/
+
+/** Coefficients of an affine map (s1,s2) -> (a11*s1 + a12*s2 + c1,
+a21*s1 + a22*s2 + c2) mod MY_RND_MAX_VALUE */
+struct my_rnd_affine
+{
+  unsigned long long a11, a12, c1;
+  unsigned long long a21, a22, c2;
+};
+
+/**
+  Compose an affine map mod MY_RND_MAX_VALUE with itself (compute
+  g(g(s)), i.e. square the transition). Cold path, executed twice per
+  my_rnd_batch() call.
+
+  @param g [IN/OUT]	the map; replaced by its square
+*/
+
+static void my_rnd_compose(struct my_rnd_affine *g)
+{
+  const unsigned long long M= MY_RND_MAX_VALUE;
+  struct my_rnd_affine	r;
+
+  r.a11= (g->a11 * g->a11 + g->a12 * g->a21) % M;
+  r.a12= (g->a11 * g->a12 + g->a12 * g->a22) % M;
+  r.c1=  (g->a11 * g->c1  + g->a12 * g->c2 + g->c1) % M;
+  r.a21= (g->a21 * g->a11 + g->a22 * g->a21) % M;
+  r.a22= (g->a21 * g->a12 + g->a22 * g->a22) % M;
+  r.c2=  (g->a21 * g->c1  + g->a22 * g->c2 + g->c2) % M;
+  *g= r;
+}
+
+/**
+  Reduce each 64-bit lane (< 2^62) mod MY_RND_MAX_VALUE.
+
+  M is 2^30 - 1, so x mod M can be computed by folding:
+  (x & M) + (x >> 30) is congruent to x mod M. Two folds bring a
+  62-bit lane below 2*M; one masked subtract completes the reduction.
+*/
+
+__attribute__((target("avx2")))
+static inline __m256i my_rnd_mod_avx2(__m256i x)
+{
+  const __m256i m= _mm256_set1_epi64x(MY_RND_MAX_VALUE);
+
+  x= _mm256_add_epi64(_mm256_and_si256(x, m), _mm256_srli_epi64(x, 30));
+  x= _mm256_add_epi64(_mm256_and_si256(x, m), _mm256_srli_epi64(x, 30));
+  return _mm256_sub_epi64(
+    x, _mm256_and_si256(m, _mm256_cmpgt_epi64(
+                             x, _mm256_set1_epi64x(MY_RND_MAX_VALUE - 1))));
+}
+
+/**
+  Generate n >= 4 random doubles with AVX2, leaving rand_st exactly as
+  n scalar my_rnd() calls would.
+*/
+
+__attribute__((target("avx2")))
+static void my_rnd_batch_avx2(struct my_rnd_struct *rand_st,
+                              double *out, size_t n)
+{
+  struct my_rnd_affine	jump= { 3, 1, 0, 3, 2, 33 };
+  unsigned long long	s1[4], s2[4];
+  ulong			prev1, prev2;
+  size_t		i, quads;
+
+  /* The four-step transition T^4 = (T^2)^2 */
+  my_rnd_compose(&jump);
+  my_rnd_compose(&jump);
+
+  /*
+    Prime the lanes with the states after steps 1..4.  Compute in ulong,
+    not 64 bits: a raw out-of-range seed must wrap exactly as it does in
+    the scalar path, also where ulong is 32 bits.
+  */
+  prev1= rand_st->seed1;
+  prev2= rand_st->seed2;
+  for (i= 0; i < 4; i++)
+  {
+    prev1= my_mod_max_value(prev1 * 3 + prev2);
+    prev2= my_mod_max_value(prev1 + prev2 + 33);
+    s1[i]= prev1;
+    s2[i]= prev2;
+  }
+
+  {
+    __m256i v1= _mm256_loadu_si256((__m256i*) s1);
+    __m256i v2= _mm256_loadu_si256((__m256i*) s2);
+    const __m256i a11= _mm256_set1_epi64x(jump.a11);
+    const __m256i a12= _mm256_set1_epi64x(jump.a12);
+    const __m256i c1=  _mm256_set1_epi64x(jump.c1);
+    const __m256i a21= _mm256_set1_epi64x(jump.a21);
+    const __m256i a22= _mm256_set1_epi64x(jump.a22);
+    const __m256i c2=  _mm256_set1_epi64x(jump.c2);
+
+    quads= n / 4;
+    for (i= 0; ; i++)
+    {
+      __m256i t1, t2;
+      size_t  j;
+
+      _mm256_storeu_si256((__m256i*) s1, v1);
+      for (j= 0; j < 4; j++)
+        out[i * 4 + j]= ((double) s1[j]) / rand_st->max_value_dbl;
+      if (i == quads - 1)
+        break;
+
+      /* Advance every lane four steps: s' = A*s + c mod M. The
+      products of two 30-bit values fit comfortably in the 64-bit
+      lanes before reduction. */
+      t1= _mm256_add_epi64(
+        _mm256_add_epi64(_mm256_mul_epu32(a11, v1),
+                         _mm256_mul_epu32(a12, v2)), c1);
+      t2= _mm256_add_epi64(
+        _mm256_add_epi64(_mm256_mul_epu32(a21, v1),
+                         _mm256_mul_epu32(a22, v2)), c2);
+      v1= my_rnd_mod_avx2(t1);
+      v2= my_rnd_mod_avx2(t2);
+    }
+
+    /* Leave rand_st at the state after the last emitted value */
+    _mm256_storeu_si256((__m256i*) s2, v2);
+    rand_st->seed1= (unsigned long) s1[3];
+    rand_st->seed2= (unsigned long) s2[3];
+  }
+
+  /* At most three leftover values */
+  for (i= quads * 4; i < n; i++)
+    out[i]= my_rnd(rand_st);
+}
+#endif /* __GNUC__ >= 5 */
+#endif /* __GNUC__ && __x86_64__ */
+
 
 /*
   A wrapper to use OpenSSL/yaSSL PRNGs.
@@ -65,11 +378,47 @@ void my_rnd_init(struct my_rnd_struct *rand_st, ulong seed1, ulong seed2)
 
 double my_rnd(struct my_rnd_struct *rand_st)
 {
+  if (rand_st->max_value == MY_RND_MAX_VALUE)
+  {
+    rand_st->seed1= my_mod_max_value(rand_st->seed1*3+rand_st->seed2);
+    rand_st->seed2= my_mod_max_value(rand_st->seed1+rand_st->seed2+33);
+    return (((double) rand_st->seed1) / rand_st->max_value_dbl);
+  }
   rand_st->seed1= (rand_st->seed1*3+rand_st->seed2) % rand_st->max_value;
   rand_st->seed2= (rand_st->seed1+rand_st->seed2+33) % rand_st->max_value;
   return (((double) rand_st->seed1) / rand_st->max_value_dbl);
 }
 
+/**
+  Generate n random numbers, exactly as n my_rnd() calls would.
+
+  On AVX2-capable CPUs the recurrence is advanced four sequence
+  positions at a time in SIMD lanes; the output and the final state
+  of rand_st are bit-identical to the scalar loop.
+
+  @param rand_st [INOUT] Structure used for number generation.
+  @param out     [OUT]   Array of n generated pseudo random numbers.
+  @param n               Number of values to generate.
+*/
+
+void my_rnd_batch(struct my_rnd_struct *rand_st, double *out, size_t n)
+{
+#ifdef HAVE_my_rnd_avx2
+  if (n >= 8 && rand_st->max_value == MY_RND_MAX_VALUE)
+  {
+    if (my_avx2_usable == -1)
+      my_avx2_usable= my_avx2_detect();
+    if (my_avx2_usable)
+    {
+      my_rnd_batch_avx2(rand_st, out, n);
+      return;
+    }
+  }
+#endif /* HAVE_my_rnd_avx2 */
+  while (n--)
+    *out++= my_rnd(rand_st);
+}
+
 /**
   Generate a random number using the OpenSSL/yaSSL supplied
   random number generator if available.
@@ -83,6 +432,22 @@ double my_rnd(struct my_rnd_struct *rand_st)
 
 double my_rnd_ssl(struct my_rnd_struct *rand_st)
 {
+#ifdef HAVE_my_rdrand
+  {
+    unsigned int hw_res;
+
+    /*
+      On CPUs with Intel Secure Key, drawing the 4 bytes directly from
+      the on-chip DRBG is much cheaper than a call into the SSL
+      library, which involves its own CSPRNG state and, with OpenSSL,
+      often a lock.
+    */
+    if (my_rdrand_usable == -1)
+      my_rdrand_usable= my_rdrand_detect();
+    if (my_rdrand_usable && my_rdrand32(&hw_res))
+      return (double)hw_res / (double)UINT_MAX;
+  }
+#endif /* HAVE_my_rdrand */
 
 #if defined(HAVE_YASSL) || defined(HAVE_OPENSSL)
   int rc;
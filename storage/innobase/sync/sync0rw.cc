@@ -382,7 +382,7 @@ lock_loop:
 	HMT_low();
 	while (i < SYNC_SPIN_ROUNDS && lock->lock_word <= 0) {
 		if (srv_spin_wait_delay) {
-			ut_delay(ut_rnd_interval(0, srv_spin_wait_delay));
+			ut_delay(ut_rnd_interval_fast(0, srv_spin_wait_delay));
 		}
 
 		i++;
@@ -483,7 +483,7 @@ rw_lock_x_lock_wait(
         HMT_low();
 	while (lock->lock_word < 0) {
 		if (srv_spin_wait_delay) {
-			ut_delay(ut_rnd_interval(0, srv_spin_wait_delay));
+			ut_delay(ut_rnd_interval_fast(0, srv_spin_wait_delay));
 		}
 		if(i < SYNC_SPIN_ROUNDS) {
 			i++;
@@ -669,8 +669,8 @@ lock_loop:
 		while (i < SYNC_SPIN_ROUNDS
 		       && lock->lock_word <= 0) {
 			if (srv_spin_wait_delay) {
-				ut_delay(ut_rnd_interval(0,
-							 srv_spin_wait_delay));
+				ut_delay(ut_rnd_interval_fast(
+						0, srv_spin_wait_delay));
 			}
 
 			i++;
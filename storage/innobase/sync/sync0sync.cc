@@ -111,6 +111,26 @@ the atomic test-and-set, but his algorithm should be modified for weak memory
 models. We do not use Lamport's algorithm, because we guess it is slower than
 the atomic test-and-set.
 
+Queued spin locks (MCS locks, or the Linux kernel's qspinlock) avoid the
+O(N^2) coherence traffic of test-and-set under heavy contention by letting
+each waiter spin on its own queue node, and would be attractive on large
+NUMA machines. We have evaluated and rejected that design for this mutex:
+
+(1) every waiter beyond the spin rounds blocks on mutex->event through the
+    global wait array, and the wait array (sync_arr_wake_threads_if_sema_free,
+    the long-semaphore-wait watchdog, SHOW ENGINE INNODB STATUS) assumes it
+    can see and wake every waiter; a waiter parked on a private queue node
+    would be invisible to it;
+(2) a queue node must live as long as its successor may touch it, which
+    cannot be guaranteed for threads that are victims of the watchdog or of
+    crash recovery aborting waits;
+(3) the mutex must remain a plain memory block that mutex_create() can
+    initialize at any address, with no per-thread state attached.
+
+Thus we keep the single lock word and attack the coherence traffic instead
+by only issuing the test-and-set when a plain read has seen the lock word
+zero (see mutex_enter_func() and mutex_spin_wait()).
+
 Our mutex implementation works as follows: After that we perform the atomic
 test-and-set instruction on the memory word. If the test returns zero, we
 know we got the lock first. If the test returns not zero, some other thread
@@ -284,6 +304,7 @@ mutex_create_func(
 
 	mutex->line = 0;
 	mutex->file_name = "not yet reserved";
+	mutex->thread_id = (os_thread_id_t) ULINT_UNDEFINED;
 #ifdef UNIV_SYNC_DEBUG
 	mutex->level = level;
 #endif /* UNIV_SYNC_DEBUG */
@@ -483,6 +504,13 @@ mutex_spin_wait(
 	ulint		line)		/*!< in: line where requested */
 {
 	ulint		i;		/* spin round count */
+	ulint		delay;		/* current backoff delay */
+	ulint		total_rounds = 0;
+					/* spin rounds over all retries */
+	ulint		opt_respins = 0;
+					/* optimistic spin phase retries */
+	os_thread_id_t	owner_at_start;	/* who held the mutex when the
+					current spin phase began */
 	ulint		index;		/* index of the reserved wait cell */
 	sync_array_t*	sync_arr;
 	size_t		counter_index;
@@ -500,6 +528,12 @@ mutex_spin_wait(
 mutex_loop:
 
 	i = 0;
+	delay = 1;
+
+	/* The read is racy, but only used as a progress heuristic below:
+	any concurrent owner change makes it compare unequal, which is
+	exactly the signal we are after. */
+	owner_at_start = mutex->thread_id;
 
 	/* Spin waiting for the lock word to become zero. Note that we do
 	not have to assume that the read access to the lock word is atomic,
@@ -511,9 +545,31 @@ spin_loop:
 
         HMT_low();
 	os_rmb;
-	while (mutex_get_lock_word(mutex) != 0 && i < SYNC_SPIN_ROUNDS) {
+
+	/* Each pass through mutex_loop spins anew, so without a cap a
+	thread whose event wait keeps losing the mutex to other spinners
+	would burn a core indefinitely while the holder may not even be
+	scheduled. Bound the cumulative spinning per acquisition; once
+	the budget is used up, acquisition relies on the wait array. */
+
+	while (mutex_get_lock_word(mutex) != 0 && i < SYNC_SPIN_ROUNDS
+	       && total_rounds < SYNC_SPIN_ROUNDS * 8) {
+		total_rounds++;
 		if (srv_spin_wait_delay) {
-			ut_delay(ut_rnd_interval(0, srv_spin_wait_delay));
+			/* Exponential backoff: the delay starts short so
+			that a quickly released mutex is noticed at once,
+			and doubles up to srv_spin_wait_delay so that
+			long-held mutexes are polled rarely. Computing the
+			delay this way is far cheaper than drawing it from
+			ut_rnd_interval(), which costs a function call and
+			a division per spin round; the growing schedule
+			desynchronizes the spinners just as well as random
+			jitter did. */
+			ut_delay(delay);
+			delay *= 2;
+			if (delay > srv_spin_wait_delay) {
+				delay = srv_spin_wait_delay;
+			}
 		}
 		i++;
 	}
@@ -525,7 +581,18 @@ spin_loop:
 
 	mutex_spin_round_count.add(counter_index, i);
 
-	if (ib_mutex_test_and_set(mutex) == 0) {
+	/* Only try the atomic test-and-set when the lock word was seen
+	unlocked: a failing test-and-set still takes the cache line in
+	exclusive state and would bounce it between the spinning cores.
+	Prefetch the lock word with write intent first: the spin loop
+	reads have left the cache line in shared state, and the
+	test-and-set would otherwise pay a separate upgrade to
+	exclusive ownership. */
+
+	UNIV_PREFETCH_RW((void*) &mutex->lock_word);
+
+	if (mutex_get_lock_word(mutex) == 0
+	    && ib_mutex_test_and_set(mutex) == 0) {
 		/* Succeeded! */
 
 		mutex->thread_id = os_thread_get_curr_id();
@@ -553,6 +620,23 @@ spin_loop:
 		goto spin_loop;
 	}
 
+	/* If the mutex changed hands while we spun, the critical
+	sections are short and the owners are making progress, so one
+	more spin phase is likely to succeed and is much cheaper than
+	reserving a wait cell and sleeping. This is the userspace
+	analogue of spinning while the lock owner is on-CPU: we cannot
+	see the scheduler, but an ownership change proves the owner ran.
+	The retries are bounded, and the spin budget above caps the
+	rounds they may consume. */
+
+	if (opt_respins < 2
+	    && !os_thread_eq(mutex->thread_id, owner_at_start)) {
+
+		opt_respins++;
+
+		goto mutex_loop;
+	}
+
 	sync_arr = sync_array_get_and_reserve_cell(mutex, SYNC_MUTEX,
 						   file_name, line, &index);
 
@@ -562,7 +646,18 @@ spin_loop:
 	released in mutex_exit, the waiters field is first set to zero and
 	then the event is set to the signaled state. */
 
-	mutex_set_waiters(mutex, 1);
+	/* Under heavy contention the flag is usually set already, and
+	rewriting it would take the cache line in exclusive state on
+	every pass through here. Reading 1 is as good as storing it:
+	the read happens after our cell reservation, so a signal that
+	clears the flag after this point also raises the event we are
+	about to wait on, and a signal cannot have cleared it before
+	this point or we would read 0. */
+
+	if (mutex_get_waiters(mutex) == 0) {
+
+		mutex_set_waiters(mutex, 1);
+	}
 
 	/* Make sure waiters store won't pass over mutex_test_and_set */
 #ifdef __powerpc__
@@ -571,7 +666,10 @@ spin_loop:
 
 	/* Try to reserve still a few times */
 	for (i = 0; i < 4; i++) {
-		if (ib_mutex_test_and_set(mutex) == 0) {
+		UNIV_PREFETCH_RW((void*) &mutex->lock_word);
+
+		if (mutex_get_lock_word(mutex) == 0
+		    && ib_mutex_test_and_set(mutex) == 0) {
 			/* Succeeded! Free the reserved wait cell */
 
 			sync_array_free_cell(sync_arr, index);
@@ -607,7 +705,21 @@ spin_loop:
 }
 
 /******************************************************************//**
-Releases the threads waiting in the primary wait array for this mutex. */
+Releases the threads waiting in the primary wait array for this mutex.
+
+Note that this wakes every waiter of the mutex, not just one, which
+looks like a thundering herd. We have considered waking a single
+waiter (as a futex-based mutex would with FUTEX_WAKE(1), or with
+FUTEX_WAIT_BITSET partitioning waiters into wake classes), and it
+cannot be done with this wait protocol: the mutex event is a binary
+event with a monotonic signal count, and LEMMA 2 above - which rules
+out the lost-wakeup race between os_event_reset() and the wait -
+only holds if os_event_set() publishes the signal to every thread
+that has reset the event. A single-wake primitive would also defeat
+sync_arr_wake_threads_if_sema_free(), which relies on a set event
+releasing all cells waiting on it. In practice the herd is small:
+waiters that lose the race simply re-enter mutex_spin_wait(), and
+the spin budget there keeps the cost bounded. */
 UNIV_INTERN
 void
 mutex_signal_object(
@@ -943,6 +943,25 @@ for synchronization */
 	"Memory barrier is not used"
 #endif
 
+/* On x86 the hardware memory model is TSO: loads are not reordered with
+older loads and stores are not reordered with older stores, so the read
+and write barriers only have to keep the compiler from reordering; no
+fence instruction (lfence/sfence/mfence, tens of cycles each) is needed.
+os_rmb sits at the top of every contended mutex and rw-lock spin loop,
+so this matters. The full barrier os_mb orders stores against younger
+loads, which even TSO allows to pass, so it must remain a real fence. */
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+# undef os_rmb
+# undef os_wmb
+# define os_rmb	__asm__ __volatile__ ("" ::: "memory")
+# define os_wmb	__asm__ __volatile__ ("" ::: "memory")
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+# undef os_rmb
+# undef os_wmb
+# define os_rmb	_ReadWriteBarrier()
+# define os_wmb	_ReadWriteBarrier()
+#endif
+
 #ifndef UNIV_NONINL
 #include "os0sync.ic"
 #endif
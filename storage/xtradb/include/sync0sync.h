@@ -308,7 +308,7 @@ NOTE! Use the corresponding macro in the header file, not this function
 directly. Locks a mutex for the current thread. If the mutex is reserved
 the function spins a preset time (controlled by SYNC_SPIN_ROUNDS) waiting
 for the mutex before suspending the thread. */
-UNIV_INLINE
+UNIV_INLINE UNIV_ALWAYS_INLINE
 void
 mutex_enter_func(
 /*=============*/
@@ -365,7 +365,7 @@ mutex_enter_nowait_func(
 /******************************************************************//**
 NOTE! Use the corresponding macro mutex_exit(), not directly this function!
 Unlocks a mutex owned by the current thread. */
-UNIV_INLINE
+UNIV_INLINE UNIV_ALWAYS_INLINE
 void
 mutex_exit_func(
 /*============*/
@@ -665,7 +665,7 @@ mutex_n_reserved(void);
 /******************************************************************//**
 NOT to be used outside this module except in debugging! Gets the value
 of the lock word. */
-UNIV_INLINE
+UNIV_INLINE UNIV_ALWAYS_INLINE
 lock_word_t
 mutex_get_lock_word(
 /*================*/
@@ -936,26 +936,69 @@ struct ib_mutex_t {
 		os_fast_mutex;	/*!< We use this OS mutex in place of lock_word
 				when atomic operations are not enabled */
 #endif
+	byte	pad1[CACHE_LINE_SIZE];
+				/*!< padding so that the lock_word, which
+				spinning threads read in a tight loop, has a
+				memory cache line of its own; otherwise every
+				update of the fields below would invalidate
+				the line in all spinning cores */
 	ulint	waiters;	/*!< This ulint is set to 1 if there are (or
 				may be) threads waiting in the global wait
 				array for this mutex to be released.
-				Otherwise, this is 0. */
-	UT_LIST_NODE_T(ib_mutex_t)	list; /*!< All allocated mutexes are put into
-				a list.	Pointers to the next and prev. */
-
-#ifdef UNIV_SYNC_DEBUG
-	ulint	level;			/*!< Level in the global latching order */
-#endif /* UNIV_SYNC_DEBUG */
+				Otherwise, this is 0.
+
+				We have considered folding this flag into
+				lock_word as a third state (UNLOCKED=0,
+				LOCKED=1, LOCKED_WAITERS=2), which would
+				make mutex_exit_func() a single atomic
+				exchange instead of a store, a full
+				barrier and a separate load. It cannot be
+				done with the primitives this tree
+				abstracts over: lock_word_t is a byte on
+				several platforms whose only operations
+				are test-and-set (which can only store 1;
+				__atomic_test_and_set() is boolean by
+				specification) and clear, so a third state
+				cannot be written portably. The separate
+				field is also what allows
+				sync_arr_wake_threads_if_sema_free() to
+				detect the released-but-waiters-set state
+				that the barrier comment in
+				mutex_exit_func() describes. */
+	byte	pad2[CACHE_LINE_SIZE];
+				/*!< padding separating the waiters flag,
+				which waiting threads store to, from the
+				bookkeeping fields below which the lock
+				holder updates */
+
+	/* Fields written or read on every acquisition come first, so
+	that they share one cache line regardless of the debug and
+	instrumentation options compiled in; the creation-time and
+	diagnostic bookkeeping further down is touched only by monitor
+	output and by the wait path, and keeping it apart means a debug
+	build has the same hot-line footprint as a production build. */
 
+	os_thread_id_t thread_id;	/*!< The thread id of the thread
+					which locked the mutex. */
 	const char*	file_name;	/*!< File where the mutex was locked */
 	ulint		line;		/*!< Line where the mutex was locked */
+#ifdef UNIV_PFS_MUTEX
+	struct PSI_mutex* pfs_psi;	/*!< The performance schema
+					instrumentation hook */
+#endif
+
+	/* Cold bookkeeping: set at creation or updated only on the
+	wait path. */
+
+	UT_LIST_NODE_T(ib_mutex_t)	list; /*!< All allocated mutexes are put into
+				a list.	Pointers to the next and prev. */
 	const char*	cfile_name;	/*!< File name where mutex created */
 	ulint		cline;		/*!< Line where created */
 	ulong		count_os_wait;	/*!< count of os_wait */
 	const char*	cmutex_name;	/*!< mutex name */
-	os_thread_id_t thread_id;	/*!< The thread id of the thread
-					which locked the mutex. */
-
+#ifdef UNIV_SYNC_DEBUG
+	ulint	level;			/*!< Level in the global latching order */
+#endif /* UNIV_SYNC_DEBUG */
 #ifdef UNIV_DEBUG
 
 /** Value of mutex_t::magic_n */
@@ -963,11 +1006,6 @@ struct ib_mutex_t {
 	ulint		magic_n;	/*!< MUTEX_MAGIC_N */
 	ulint		ib_mutex_type;	/*!< 0=usual mutex, 1=rw_lock mutex */
 #endif /* UNIV_DEBUG */
-
-#ifdef UNIV_PFS_MUTEX
-	struct PSI_mutex* pfs_psi;	/*!< The performance schema
-					instrumentation hook */
-#endif
 };
 
 /** XtraDB priority mutex */
@@ -295,6 +295,19 @@ rarely invoked function for size instead for speed. */
 
 #define UNIV_INLINE static inline
 
+/** Force inlining of a UNIV_INLINE function. The shortest mutex
+operations are two-instruction affairs in the uncontended case, and at
+-O levels where the compiler weighs code size it may still emit them
+as calls; the call overhead then dwarfs the operation itself. Use only
+on such leaf functions. */
+# ifdef __GNUC__
+#  define UNIV_ALWAYS_INLINE MY_ATTRIBUTE((always_inline))
+# elif defined(_MSC_VER)
+#  define UNIV_ALWAYS_INLINE __forceinline
+# else
+#  define UNIV_ALWAYS_INLINE
+# endif
+
 #else /* !UNIV_MUST_NOT_INLINE */
 /* If we want to compile a noninlined version we use the following macro
 definitions: */
@@ -302,6 +315,10 @@ definitions: */
 #define UNIV_NONINL
 #define UNIV_INLINE	UNIV_INTERN
 
+/* When compiling the noninlined version the functions are ordinary
+out-of-line functions and must not carry an always_inline hint. */
+#define UNIV_ALWAYS_INLINE
+
 #endif /* !UNIV_MUST_NOT_INLINE */
 
 #ifdef _WIN32
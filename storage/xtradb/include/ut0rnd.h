@@ -70,6 +70,21 @@ ut_rnd_interval(
 /*============*/
 	ulint	low,	/*!< in: low limit; can generate also this value */
 	ulint	high);	/*!< in: high limit; can generate also this value */
+/********************************************************//**
+Generates a random integer from a given interval with a cheap
+xorshift generator. Unlike ut_rnd_interval() this needs no division
+and touches no multiplier chain, so it is suitable for use inside
+spin-wait loops where the jitter computation must cost less than the
+delay it schedules. The generator state is deliberately updated
+without synchronization: races merely perturb the sequence, which is
+harmless for jitter.
+@return	the 'random' number */
+UNIV_INLINE
+ulint
+ut_rnd_interval_fast(
+/*=================*/
+	ulint	low,	/*!< in: low limit; can generate also this value */
+	ulint	high);	/*!< in: high limit */
 /*********************************************************//**
 Generates a random iboolean value.
 @return	the random value */
@@ -441,7 +441,15 @@ thread C calls os_event_wait()  [infinite wait!]
 
 Where such a scenario is possible, to avoid infinite wait, the
 value returned by os_event_reset() should be passed in as
-reset_sig_count. */
+reset_sig_count.
+
+On Linux one could block on the lock word directly with the raw futex
+syscall and skip this condition variable machinery and the glibc
+wrapper overhead around it. We have not done so: the signal_count
+protocol above is exactly what FUTEX_WAIT's compare-and-block argument
+would have to replicate, every other platform would still need this
+code, and the syscall only appears on the already-slow wait path, so
+the saving would be a few dozen cycles under a context switch. */
 UNIV_INTERN
 void
 os_event_wait_low(
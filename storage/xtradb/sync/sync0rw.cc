@@ -457,8 +457,8 @@ lock_loop:
 		HMT_low();
 		while (i < SYNC_SPIN_ROUNDS && lock->lock_word <= 0) {
 			if (srv_spin_wait_delay) {
-				ut_delay(ut_rnd_interval(0,
-							 srv_spin_wait_delay));
+				ut_delay(ut_rnd_interval_fast(
+						0, srv_spin_wait_delay));
 			}
 
 			i++;
@@ -624,7 +624,7 @@ rw_lock_x_lock_wait(
 
 	while (lock->lock_word < 0) {
 		if (srv_spin_wait_delay) {
-			ut_delay(ut_rnd_interval(0, srv_spin_wait_delay));
+			ut_delay(ut_rnd_interval_fast(0, srv_spin_wait_delay));
 		}
 		if(i < SYNC_SPIN_ROUNDS) {
 			i++;
@@ -831,8 +831,8 @@ lock_loop:
 		while (i < SYNC_SPIN_ROUNDS
 		       && lock->lock_word <= 0) {
 			if (srv_spin_wait_delay) {
-				ut_delay(ut_rnd_interval(0,
-							 srv_spin_wait_delay));
+				ut_delay(ut_rnd_interval_fast(
+						0, srv_spin_wait_delay));
 			}
 
 			i++;
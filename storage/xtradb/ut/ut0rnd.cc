@@ -39,6 +39,10 @@ Created 5/11/1994 Heikki Tuuri
 /** Seed value of ut_rnd_gen_ulint(). */
 UNIV_INTERN ulint	ut_rnd_ulint_counter = 65654363;
 
+/** State of the xorshift generator behind ut_rnd_interval_fast();
+any nonzero seed works */
+UNIV_INTERN ib_uint64_t	ut_rnd_xorshift_state = 88172645463325252ULL;
+
 /***********************************************************//**
 Looks for a prime number slightly greater than the given argument.
 The prime is chosen so that it is not near any power of 2.
@@ -0,0 +1,163 @@
+/* Copyright (c) 2016, MariaDB Corporation
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#include <my_global.h>
+#include <my_sys.h>
+#include <my_rnd.h>
+#include <tap.h>
+#include <string.h>
+
+/*
+  The my_rnd() fast path replaces the % in the recurrence by Mersenne
+  folding, and my_rnd_batch() may advance the recurrence four sequence
+  positions at a time in SIMD lanes. Both must stay bit-for-bit
+  identical to the plain division code below: the password scramble
+  and replication of RAND() depend on the exact sequence, and the
+  seeds are not guaranteed to be below the modulus (SET SESSION
+  rand_seed1/rand_seed2 and a replicated RAND_EVENT store raw values
+  without reduction).
+*/
+
+#define RND_MAX_VALUE 0x3FFFFFFFUL
+
+static double ref_rnd(struct my_rnd_struct *rand_st)
+{
+  rand_st->seed1= (rand_st->seed1*3+rand_st->seed2) % rand_st->max_value;
+  rand_st->seed2= (rand_st->seed1+rand_st->seed2+33) % rand_st->max_value;
+  return (((double) rand_st->seed1) / rand_st->max_value_dbl);
+}
+
+static void set_state(struct my_rnd_struct *rand_st,
+                      ulong seed1, ulong seed2)
+{
+  rand_st->seed1= seed1;
+  rand_st->seed2= seed2;
+  rand_st->max_value= RND_MAX_VALUE;
+  rand_st->max_value_dbl= (double) rand_st->max_value;
+}
+
+/* Seeds as SET SESSION rand_seed1/rand_seed2 may install them: not
+reduced, including values far above the modulus */
+static const ulong test_seeds[]=
+{
+  0, 1, 33, 12345, RND_MAX_VALUE - 1, RND_MAX_VALUE, RND_MAX_VALUE + 1,
+  2 * RND_MAX_VALUE, 4 * RND_MAX_VALUE - 1, (ulong) 0xFFFFFFFFUL,
+  (ulong) 0x123456789AULL, (ulong) 1ULL << 45, (ulong) 1ULL << 62,
+  (ulong) 0xDEADBEEFCAFEBABEULL, (ulong) ~0UL
+};
+
+#define N_SEEDS (sizeof(test_seeds)/sizeof(test_seeds[0]))
+#define SEQ_STEPS 200
+#define BATCH_MAX 67
+
+/*
+  Exhaustively drive the first recurrence sum through [low, high) and
+  compare my_rnd() against the division reference. 3 is odd and hence
+  invertible mod 2^N, so with seed2 == 0 the seed that produces the
+  sum x is exactly x * 3^-1; this reaches every operand value, which
+  no walk over the seeds themselves could. Truncating the 64-bit
+  inverse gives the inverse for 32-bit ulong as well.
+*/
+
+static int check_sum_range(ulonglong low, ulonglong high, ulonglong step)
+{
+  const ulong inv3= (ulong) 0xAAAAAAAAAAAAAAABULL;
+  ulonglong x;
+
+  for (x= low; x < high; x+= step)
+  {
+    struct my_rnd_struct a, b;
+
+    set_state(&a, (ulong) x * inv3, 0);
+    set_state(&b, (ulong) x * inv3, 0);
+    if (my_rnd(&a) != ref_rnd(&b) ||
+        a.seed1 != b.seed1 || a.seed2 != b.seed2)
+    {
+      diag("mismatch at sum %llu: seed1 %lu vs %lu, seed2 %lu vs %lu",
+           x, a.seed1, b.seed1, a.seed2, b.seed2);
+      return 0;
+    }
+  }
+  return 1;
+}
+
+int main(int argc __attribute__((unused)), char *argv[])
+{
+  size_t i, j, n;
+  int ok_seq= 1, ok_batch= 1;
+  MY_INIT(argv[0]);
+
+  plan(4);
+
+  /* Every operand the single-fold version was valid for, and the
+  boundary region just above it */
+  ok(check_sum_range(0, 4ULL * RND_MAX_VALUE + 4096, 1),
+     "fold identical to division over the full [0, 4*M) domain");
+
+  /* Strided coverage of the rest of the 64-bit operand range */
+  ok(check_sum_range(4ULL * RND_MAX_VALUE, ULONGLONG_MAX - (1ULL << 44),
+                     (1ULL << 44) + 12345),
+     "fold identical to division for large 64-bit operands");
+
+  for (i= 0; i < N_SEEDS; i++)
+  {
+    for (j= 0; j < N_SEEDS; j++)
+    {
+      struct my_rnd_struct a, b;
+      size_t step;
+
+      /* Sequence identity from directly-set, possibly out-of-range
+      seeds, as after SET SESSION rand_seed1/rand_seed2 */
+      set_state(&a, test_seeds[i], test_seeds[j]);
+      set_state(&b, test_seeds[i], test_seeds[j]);
+      for (step= 0; step < SEQ_STEPS; step++)
+      {
+        if (my_rnd(&a) != ref_rnd(&b) ||
+            a.seed1 != b.seed1 || a.seed2 != b.seed2)
+        {
+          diag("sequence diverges: seeds %lu/%lu step %u",
+               test_seeds[i], test_seeds[j], (uint) step);
+          ok_seq= 0;
+        }
+      }
+
+      /* my_rnd_batch() must emit what n my_rnd() calls would and
+      leave the same final state, for lengths around the SIMD width */
+      for (n= 1; n < BATCH_MAX; n++)
+      {
+        double out_batch[BATCH_MAX], out_ref[BATCH_MAX];
+        size_t k;
+
+        set_state(&a, test_seeds[i], test_seeds[j]);
+        set_state(&b, test_seeds[i], test_seeds[j]);
+        my_rnd_batch(&a, out_batch, n);
+        for (k= 0; k < n; k++)
+          out_ref[k]= ref_rnd(&b);
+        if (memcmp(out_batch, out_ref, n * sizeof(double)) ||
+            a.seed1 != b.seed1 || a.seed2 != b.seed2)
+        {
+          diag("batch diverges: seeds %lu/%lu n %u",
+               test_seeds[i], test_seeds[j], (uint) n);
+          ok_batch= 0;
+        }
+      }
+    }
+  }
+  ok(ok_seq, "sequence identical to division for out-of-range seeds");
+  ok(ok_batch, "my_rnd_batch() identical to repeated my_rnd()");
+
+  my_end(0);
+  return exit_status();
+}